@@ -0,0 +1,62 @@
+#include "routeoptimizer.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace
+{
+// random stops within ~30 km of the city centre, every other pair is receive -> deliver
+QVector<RouteOptimizer::Stop> randomStops( const int count, std::mt19937& random )
+{
+    std::uniform_real_distribution<double> latitude( 50.30, 50.60 );
+    std::uniform_real_distribution<double> longitude( 30.30, 30.75 );
+
+    QVector<RouteOptimizer::Stop> stops( count );
+    for (int i = 0; i < count; ++i) {
+        stops[i].point = GeoPoint( latitude( random ), longitude( random ) );
+    }
+    for (int i = 0; i + 1 < count; i += 4) {
+        stops[i + 1].after = i;
+    }
+    return stops;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    const int count = argc > 1 ? atoi( argv[1] ) : 1000;
+    const int runs  = argc > 2 ? atoi( argv[2] ) : 20;
+    const GeoPoint depot( 50.45, 30.52 );
+
+    std::mt19937 random( 2013 ); // fixed seed, runs are comparable
+    QVector<qint64> times;
+    double routeKm = 0.0;
+    double inputKm = 0.0;
+
+    for (int run = 0; run < runs; ++run) {
+        const QVector<RouteOptimizer::Stop> stops = randomStops( count, random );
+        QVector<int> inputOrder( count );
+        for (int i = 0; i < count; ++i) {
+            inputOrder[i] = i;
+        }
+
+        RouteOptimizer optimizer;
+        QElapsedTimer timer;
+        timer.start();
+        const QVector<int> order = optimizer.plan( depot, stops );
+        times.append( timer.nsecsElapsed() );
+
+        routeKm += RouteOptimizer::length( depot, stops, order );
+        inputKm += RouteOptimizer::length( depot, stops, inputOrder );
+    }
+
+    std::sort( times.begin(), times.end() );
+    printf( "stops: %d, runs: %d\n", count, runs );
+    printf( "plan time, ms: min %.2f, median %.2f, max %.2f\n",
+            times.first() / 1e6, times[times.size() / 2] / 1e6, times.last() / 1e6 );
+    printf( "route length, km: %.1f (database order %.1f)\n",
+            routeKm / runs, inputKm / runs );
+    return 0;
+}
@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Route optimizer benchmark: qmake && make && ./routebench [stops] [runs]
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = routebench
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+TEMPLATE = app
+
+INCLUDEPATH += ..
+
+SOURCES += routebench.cpp \
+    ../routeoptimizer.cpp \
+    ../spatialindex.cpp
+
+HEADERS += ../geopoint.h \
+    ../spatialindex.h \
+    ../routeoptimizer.h
@@ -0,0 +1,82 @@
+#include "courierdatabase.h"
+#include <QSettings>
+#include <QDebug>
+
+QSqlDatabase addCourierDatabase(const QString &connectionName)
+{
+    QSettings settings( "settings.ini", QSettings::IniFormat );
+
+    settings.beginGroup( "database" );
+    const QString dbDriver( settings.value( "driver",   "QOCI"      ).toString() );
+    const QString hostName( settings.value( "hostname", "localhost" ).toString() );
+    const QString dbName( settings.value( "database", "bookstore" ).toString() );
+    const QString userName( settings.value( "user",     QString()   ).toString() );
+    const QString password( settings.value( "password", QString()   ).toString() );
+    const int port( settings.value( "port", "1521").toInt());
+    settings.endGroup();
+
+    if (connectionName.isEmpty()) {
+        qDebug() << "driver: " << dbDriver;
+        qDebug() << "hostname: " << hostName;
+        qDebug() << "database: " << dbName;
+        qDebug() << "username: " << userName;
+        qDebug() << "password: " << password;
+        qDebug() << "port: " << port;
+    }
+
+    QSqlDatabase db = connectionName.isEmpty() ? QSqlDatabase::addDatabase( dbDriver )
+                                               : QSqlDatabase::addDatabase( dbDriver, connectionName );
+    db.setHostName(     hostName );
+    db.setDatabaseName( dbName );
+    db.setUserName(     userName );
+    db.setPassword(     password );
+    db.setPort( port );
+    return db;
+}
+
+QString claimedOrdersQuery(const uint courierID)
+{
+    return QString(
+                 "SELECT h.dr"
+                      ", to_char( h.purchasing_date, 'J SSSSS')"
+                      ", h.customer_id"
+                      ", h.isbn"
+                      ", h.address"
+                      ", book.title"
+                      ", c.name"
+                      ", c.phone "
+                      ", h.commnt "
+                 "FROM "
+                    "("
+                      "SELECT 'Receive' dr"
+                           ", b.purchasing_date"
+                           ", b.isbn"
+                           ", b.customer_id"
+                           ", b.address"
+                           ", b.commnt "
+                      "FROM book_to_receive b "
+                           "JOIN receiving d ON "
+                                 "b.purchasing_date = d.purchasing_date "
+                             "AND b.isbn = d.isbn "
+                             "AND b.customer_id = d.customer_id "
+                      "WHERE d.courier_id = %0 "
+                    "UNION "
+                      "SELECT 'Deliver' dr"
+                           ", b.purchasing_date"
+                           ", b.isbn"
+                           ", b.customer_id"
+                           ", b.address"
+                           ", b.commnt "
+                      "FROM book_to_deliver b "
+                           "JOIN delivery d ON "
+                                "b.purchasing_date = d.purchasing_date "
+                            "AND b.isbn = d.isbn "
+                            "AND b.customer_id = d.customer_id "
+                      "WHERE d.courier_id = %1 "
+                    ") h "
+                      "JOIN book ON "
+                           "book.isbn = h.isbn "
+                      "JOIN customer c ON "
+                           "c.customer_id = h.customer_id"
+                      ).arg(courierID).arg(courierID);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QSqlDatabase>
+#include <QString>
+
+/**
+ * @brief Registers a connection configured from the [database] group of settings.ini
+ * @param connectionName empty for the default connection. Other threads need
+ *        their own named connection: a connection is usable only in its thread.
+ */
+QSqlDatabase addCourierDatabase( const QString& connectionName = QString() );
+
+/**
+ * @brief Claimed receive/deliver orders of a courier, columns:
+ * dr, purchasing date ('J SSSSS'), customer id, isbn, address, title,
+ * customer name, customer phone, comment
+ */
+QString claimedOrdersQuery( const uint courierID );
@@ -16,14 +16,35 @@ TEMPLATE = app
 SOURCES += main.cpp\
         mainwindow.cpp \
     logindialog.cpp \
-    commentdialog.cpp
+    commentdialog.cpp \
+    geocodecache.cpp \
+    spatialindex.cpp \
+    orderproxymodel.cpp \
+    routeoptimizer.cpp \
+    courierdatabase.cpp \
+    manifestexporter.cpp \
+    rowarena.cpp \
+    ordertablemodel.cpp \
+    memorystats.cpp
 
 HEADERS  += mainwindow.h \
     logindialog.h \
-    commentdialog.h
+    commentdialog.h \
+    geopoint.h \
+    geocodecache.h \
+    spatialindex.h \
+    orderproxymodel.h \
+    routeoptimizer.h \
+    courierdatabase.h \
+    manifestexporter.h \
+    rowarena.h \
+    ordertablemodel.h \
+    memorystats.h
 
 FORMS    += mainwindow.ui \
     logindialog.ui \
     commentdialog.ui
 
+win32: LIBS += -lpsapi
+
 OTHER_FILES +=
@@ -0,0 +1,57 @@
+#include "geocodecache.h"
+#include <QFile>
+#include <QDebug>
+
+GeocodeCache::GeocodeCache()
+{
+}
+
+int GeocodeCache::load(const QString &fileName)
+{
+    m_points.clear();
+
+    QFile file( fileName );
+    if (!file.open( QIODevice::ReadOnly )) {
+        qDebug() << "Geocode cache is not available: " << fileName;
+        return -1;
+    }
+
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8( file.readLine() ).trimmed();
+        if (line.isEmpty() || line.startsWith( '#' )) {
+            continue;
+        }
+
+        // address itself may contain ';', coordinates are the last two fields
+        const int lonSep = line.lastIndexOf( ';' );
+        const int latSep = -1 == lonSep ? -1 : line.lastIndexOf( ';', lonSep - 1 );
+        if (latSep <= 0) {
+            qDebug() << "Geocode: malformed line " << line;
+            continue;
+        }
+
+        bool latOk = false;
+        bool lonOk = false;
+        const double latitude  = line.mid( latSep + 1, lonSep - latSep - 1 ).trimmed().toDouble( &latOk );
+        const double longitude = line.mid( lonSep + 1 ).trimmed().toDouble( &lonOk );
+        if (!latOk || !lonOk) {
+            qDebug() << "Geocode: malformed line " << line;
+            continue;
+        }
+
+        m_points.insert( normalize( line.left( latSep ) ), GeoPoint( latitude, longitude ) );
+    }
+
+    qDebug() << "Geocode cache: " << m_points.size() << " addresses";
+    return m_points.size();
+}
+
+GeoPoint GeocodeCache::lookup(const QString &address) const
+{
+    return m_points.value( normalize( address ) );
+}
+
+QString GeocodeCache::normalize(const QString &address)
+{
+    return address.simplified().toLower();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "geopoint.h"
+#include <QHash>
+#include <QString>
+
+/**
+ * @brief Local address -> coordinates lookup table.
+ *
+ * Seeded from a text file, one "address;latitude;longitude" per line
+ * (lines starting with '#' are skipped). No geocoding service is queried:
+ * an address missing from the file simply has no coordinates.
+ */
+class GeocodeCache
+{
+public:
+    GeocodeCache();
+
+    /**
+     * @brief Replaces cache contents with entries from fileName
+     * @return number of entries loaded, -1 if the file cannot be opened
+     */
+    int load( const QString& fileName );
+
+    /**
+     * @brief Coordinates of address, invalid GeoPoint if unknown
+     */
+    GeoPoint lookup( const QString& address ) const;
+
+    int size() const { return m_points.size(); }
+
+    /**
+     * @brief Key used for lookups: case and whitespace insensitive
+     */
+    static QString normalize( const QString& address );
+
+private:
+    QHash<QString, GeoPoint> m_points;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cmath>
+
+/**
+ * @brief Geographic coordinate in degrees
+ */
+struct GeoPoint
+{
+    GeoPoint()
+      : latitude( 0.0 ), longitude( 0.0 ), valid( false ) {}
+    GeoPoint( const double iLatitude, const double iLongitude )
+      : latitude( iLatitude ), longitude( iLongitude ), valid( true ) {}
+
+    double latitude;
+    double longitude;
+    bool   valid;
+};
+
+/**
+ * @brief Point on a local flat map, coordinates in kilometres
+ */
+struct PlanarPoint
+{
+    double x;
+    double y;
+};
+
+/**
+ * @brief Equirectangular projection around refLatitude.
+ * Distortion is negligible within a city, which is all couriers need.
+ */
+inline PlanarPoint toPlane( const GeoPoint& point, const double refLatitude )
+{
+    static const double kmPerDegree = 111.195; // 6371 km * pi / 180
+    static const double radPerDegree = 0.017453292519943295;
+
+    PlanarPoint p;
+    p.x = point.longitude * kmPerDegree * std::cos( refLatitude * radPerDegree );
+    p.y = point.latitude * kmPerDegree;
+    return p;
+}
+
+inline double squaredDistance( const PlanarPoint& a, const PlanarPoint& b )
+{
+    const double dx = a.x - b.x;
+    const double dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
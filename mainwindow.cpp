@@ -2,8 +2,13 @@
 #include "ui_mainwindow.h"
 #include "logindialog.h"
 #include "commentdialog.h"
+#include "orderproxymodel.h"
+#include "routeoptimizer.h"
+#include "courierdatabase.h"
+#include "manifestexporter.h"
+#include "ordertablemodel.h"
+#include "memorystats.h"
 #include <QSqlDatabase>
-#include <QSqlQueryModel>
 #include <QItemSelectionModel>
 #include <QSqlQuery>
 #include <QSettings>
@@ -12,7 +17,13 @@
 #include <QTimer>
 #include <QKeySequence>
 #include <QSqlError>
-#include <QSqlRecord>
+#include <QElapsedTimer>
+#include <QApplication>
+#include <QDir>
+#include <QFileDialog>
+#include <QInputDialog>
+#include <QThread>
+#include <climits>
 
 namespace
 {
@@ -33,6 +44,15 @@ struct DBOpener
 
     }
 };
+
+/**
+ * @brief Purchasing date, customer and ISBN identify an order in both
+ *        book_to_receive and book_to_deliver
+ */
+QString orderKey( const OrderTableModel * const model, const int row )
+{
+    return model->value( row, 1 ) + '|' + model->value( row, 2 ) + '|' + model->value( row, 3 );
+}
 }
 
 MainWindow::MainWindow(QWidget *parent)
@@ -41,18 +61,28 @@ MainWindow::MainWindow(QWidget *parent)
   , m_login(new LoginDialog(this))
   , m_commentDialog( new CommentDialog( this ))
   , m_courierID( 0 )
-  , m_inputModel( new QSqlQueryModel( this ) )
-  , m_inputSelectionModel( new QItemSelectionModel( m_inputModel, this ) )
-  , m_selectedModel( new QSqlQueryModel( this ))
-  , m_selectedSelectionModel( new QItemSelectionModel( m_selectedModel, this ))
+  , m_inputModel( new OrderTableModel( this ) )
+  , m_inputProxy( new OrderProxyModel( this ) )
+  , m_inputSelectionModel( new QItemSelectionModel( m_inputProxy, this ) )
+  , m_selectedModel( new OrderTableModel( this ))
+  , m_selectedProxy( new OrderProxyModel( this ) )
+  , m_selectedSelectionModel( new QItemSelectionModel( m_selectedProxy, this ))
+  , m_nearbyRadiusKm( 0.0 )
+  , m_exportJob( new ManifestExportJob( this ) )
+  , m_exportThreads( 1 )
 {
     ui->setupUi(this);
     setupConnection();
+    setupGeocoding();
+    setupMemoryBudget();
+    setupExport();
 
-    ui->tableView->setModel(m_inputModel);
+    m_inputProxy->setSourceModel( m_inputModel );
+    ui->tableView->setModel( m_inputProxy );
     ui->tableView->setSelectionModel( m_inputSelectionModel );
 
-    ui->selectedView->setModel( m_selectedModel);
+    m_selectedProxy->setSourceModel( m_selectedModel );
+    ui->selectedView->setModel( m_selectedProxy );
     ui->selectedView->setSelectionModel( m_selectedSelectionModel);
 
     QTimer::singleShot(10, this, SLOT(processLogin()));
@@ -65,7 +95,11 @@ MainWindow::MainWindow(QWidget *parent)
     connect( ui->actionDeselect, SIGNAL(triggered()), this, SLOT(deselectBook()));
     connect( ui->actionMark_as_Delivered, SIGNAL(triggered()), this, SLOT(markBook()));
     connect( ui->actionChange_comment, SIGNAL(triggered()), this, SLOT(editComment()));
+    connect( ui->actionExport_manifest, SIGNAL(triggered()), this, SLOT(exportManifest()));
+    connect( ui->actionExport_all_manifests, SIGNAL(triggered()), this, SLOT(exportAllManifests()));
+    connect( m_exportJob, SIGNAL(finished(int,int)), this, SLOT(manifestsExported(int,int)));
     connect( ui->tabWidget, SIGNAL(currentChanged(int)), this, SLOT(currentTabChanged(int)));
+    connect( ui->nearestFirstBox, SIGNAL(toggled(bool)), this, SLOT(applyInputOrder()));
 
     connect( m_inputSelectionModel, SIGNAL(currentRowChanged(QModelIndex,QModelIndex)),
              this, SLOT(inputSelectionChanged(QModelIndex,QModelIndex)));
@@ -75,7 +109,7 @@ MainWindow::MainWindow(QWidget *parent)
 
 void MainWindow::editComment()
 {
-    const int row = m_selectedSelectionModel->currentIndex().row();
+    const int row = m_selectedProxy->sourceRow( m_selectedSelectionModel->currentIndex() );
     if (-1 == row) {
         return;
     }
@@ -88,10 +122,8 @@ void MainWindow::editComment()
 
         DBOpener db( this );
 
-        const QSqlRecord& record = m_selectedModel->record( row );
-
         QSqlQuery query;
-        if ( "Deliver" == record.value( 0 ) ) {
+        if ( "Deliver" == m_selectedModel->value( row, 0 ) ) {
             qDebug() << "Prepare: " <<
                     query.prepare( "UPDATE book_to_deliver "
                                    "SET commnt = :newc "
@@ -111,9 +143,9 @@ void MainWindow::editComment()
         }
 
         query.bindValue( ":newc", newComment );
-        query.bindValue( ":dt", record.value( 1 ));
-        query.bindValue( ":cust", record.value( 2 ));
-        query.bindValue( ":isbn", record.value( 3 ));
+        query.bindValue( ":dt", m_selectedModel->value( row, 1 ));
+        query.bindValue( ":cust", m_selectedModel->value( row, 2 ));
+        query.bindValue( ":isbn", m_selectedModel->value( row, 3 ));
 
         qDebug() << "Transaction: " <<
                     QSqlDatabase::database().transaction();
@@ -132,6 +164,108 @@ void MainWindow::editComment()
     }
 }
 
+void MainWindow::exportManifest()
+{
+    if (0 == m_courierID) {
+        qDebug() << "No courier is logined.";
+        return;
+    }
+
+    const QString csvFilter = tr("CSV (*.csv)");
+    QString filter = csvFilter;
+    const QString fileName = QFileDialog::getSaveFileName( this
+                                                           , tr("Export manifest")
+                                                           , ManifestExporter::fileName( QDir::currentPath(), m_courierID, ManifestExporter::Csv )
+                                                           , csvFilter + ";;" + tr("Binary manifest (*.dcm)")
+                                                           , &filter );
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    // typed extension wins over the chosen filter
+    const bool binary = fileName.endsWith( ".dcm", Qt::CaseInsensitive )
+                     || (csvFilter != filter && !fileName.endsWith( ".csv", Qt::CaseInsensitive ));
+    const ManifestExporter::Format format = binary ? ManifestExporter::Binary : ManifestExporter::Csv;
+
+    DBOpener db( this );
+
+    QApplication::setOverrideCursor( Qt::WaitCursor );
+    const bool ok = ManifestExporter::exportCourier( QSqlDatabase::database(), m_courierID, fileName, format );
+    QApplication::restoreOverrideCursor();
+
+    if (!ok) {
+        QMessageBox::critical( this, tr("Export error"), tr("Cannot export manifest to %1").arg( fileName ) );
+    }
+}
+
+void MainWindow::exportAllManifests()
+{
+    if (!m_dispatcherIDs.contains( m_courierID ) || m_exportJob->isRunning()) {
+        qDebug() << "Export of all manifests is not allowed now.";
+        return;
+    }
+
+    const QString directory = QFileDialog::getExistingDirectory( this, tr("Export manifests of all couriers") );
+    if (directory.isEmpty()) {
+        return;
+    }
+
+    bool accepted = false;
+    const QString csv = tr("CSV");
+    const QString format = QInputDialog::getItem( this
+                                                  , tr("Export manifests of all couriers")
+                                                  , tr("Format:")
+                                                  , QStringList() << csv << tr("Binary")
+                                                  , 0
+                                                  , false
+                                                  , &accepted );
+    if (!accepted) {
+        return;
+    }
+
+    QList<uint> couriers;
+    {
+        DBOpener db( this );
+
+        QSqlQuery query;
+        query.setForwardOnly( true );
+        qDebug() << "Exec: " << query.exec( "SELECT courier_id FROM courier ORDER BY courier_id" );
+        while (query.next()) {
+            couriers.append( query.value( 0 ).toUInt() );
+        }
+    }
+
+    m_exportJob->start( couriers
+                        , directory
+                        , csv == format ? ManifestExporter::Csv : ManifestExporter::Binary
+                        , m_exportThreads );
+    if (m_exportJob->isRunning()) {
+        updateExportActions();
+        ui->statusbar->showMessage( tr("Exporting %1 manifests to %2...").arg( couriers.size() ).arg( directory ) );
+    }
+}
+
+void MainWindow::manifestsExported(const int written, const int total)
+{
+    updateExportActions();
+
+    if (written != total) {
+        QMessageBox::critical( this
+                               , tr("Export error")
+                               , tr("Exported %1 of %2 manifests").arg( written ).arg( total ) );
+    }
+    else {
+        ui->statusbar->showMessage( tr("Exported %1 manifests").arg( written ) );
+    }
+}
+
+void MainWindow::updateExportActions()
+{
+    const bool idle = !m_exportJob->isRunning();
+    ui->actionExport_manifest->setEnabled( idle );
+    ui->actionExport_all_manifests->setEnabled( idle && m_dispatcherIDs.contains( m_courierID ) );
+}
+
 void MainWindow::selSelectionChanged(const QModelIndex &current, const QModelIndex &previous)
 {
     const int curr = current.row();
@@ -148,7 +282,8 @@ void MainWindow::selSelectionChanged(const QModelIndex &current, const QModelInd
     ui->pushButton_4->setEnabled( -1 != curr );
 
     if (-1 != curr) { // load comment
-        ui->commentLabel->setText( m_selectedModel->record( curr ).value( 8 ).toString() );
+        const int row = m_selectedProxy->sourceRow( current );
+        ui->commentLabel->setText( commentOf( row ) );
     }
     else {
         ui->commentLabel->clear();
@@ -234,8 +369,9 @@ void MainWindow::redrawForSelect()
                                           "JOIN customer c ON "
                                                "c.customer_id = h.customer_id"
                                      );
+    query.setForwardOnly( true );
     qDebug() << "Exec: " << query.exec();
-    m_inputModel->setQuery( query);
+    m_inputModel->load( query );
     m_inputModel->setHeaderData( 0, Qt::Horizontal, tr("Receive/Deliver"));
     m_inputModel->setHeaderData( 1, Qt::Horizontal, tr("Date of purchase"));
     m_inputModel->setHeaderData( 2, Qt::Horizontal, tr("CustomerID"));
@@ -249,6 +385,49 @@ void MainWindow::redrawForSelect()
     ui->tableView->hideColumn( 7 ); // phonev
     ui->tableView->resizeColumnsToContents();
     qDebug() << m_inputModel->rowCount();
+
+    rebuildAvailableIndex();
+    applyInputOrder();
+    reportMemory();
+}
+
+void MainWindow::rebuildAvailableIndex()
+{
+    QVector<SpatialIndex::Entry> entries;
+    entries.reserve( m_inputModel->rowCount() );
+    for (int row = 0; row < m_inputModel->rowCount(); ++row) {
+        SpatialIndex::Entry entry;
+        entry.id = row;
+        entry.point = m_geocodes.lookup( m_inputModel->value( row, 4 ) ); // address
+        entries.append( entry );
+    }
+    m_availableIndex.rebuild( entries );
+    qDebug() << "Geocoded: " << m_availableIndex.size() << "/" << entries.size();
+}
+
+void MainWindow::applyInputOrder()
+{
+    if (!m_currentStop.valid || m_availableIndex.isEmpty()) {
+        m_inputProxy->clearRanks();
+        ui->statusbar->clearMessage();
+        return;
+    }
+
+    if (ui->nearestFirstBox->isChecked()) {
+        const QVector<SpatialIndex::Hit> hits =
+                m_availableIndex.nearest( m_currentStop, m_availableIndex.size() );
+        QVector<int> ranks( m_inputModel->rowCount(), INT_MAX );
+        for (int i = 0; i < hits.size(); ++i) {
+            ranks[hits[i].id] = i;
+        }
+        m_inputProxy->setRanks( ranks );
+    }
+    else {
+        m_inputProxy->clearRanks();
+    }
+
+    const int nearby = m_availableIndex.withinRadius( m_currentStop, m_nearbyRadiusKm ).size();
+    ui->statusbar->showMessage( tr("%1 orders within %2 km").arg( nearby ).arg( m_nearbyRadiusKm ) );
 }
 
 void MainWindow::redrawSelected()
@@ -262,52 +441,11 @@ void MainWindow::redrawSelected()
 
     QSqlQuery query;
     qDebug() << "Prepare: " <<
-                query.prepare(QString(
-                             "SELECT h.dr"
-                                  ", to_char( h.purchasing_date, 'J SSSSS')"
-                                  ", h.customer_id"
-                                  ", h.isbn"
-                                  ", h.address"
-                                  ", book.title"
-                                  ", c.name"
-                                  ", c.phone "
-                                  ", h.commnt "
-                             "FROM "
-                                "("
-                                  "SELECT 'Receive' dr"
-                                       ", b.purchasing_date"
-                                       ", b.isbn"
-                                       ", b.customer_id"
-                                       ", b.address"
-                                       ", b.commnt "
-                                  "FROM book_to_receive b "
-                                       "JOIN receiving d ON "
-                                             "b.purchasing_date = d.purchasing_date "
-                                         "AND b.isbn = d.isbn "
-                                         "AND b.customer_id = d.customer_id "
-                                  "WHERE d.courier_id = %0 "
-                                "UNION "
-                                  "SELECT 'Deliver' dr"
-                                       ", b.purchasing_date"
-                                       ", b.isbn"
-                                       ", b.customer_id"
-                                       ", b.address"
-                                       ", b.commnt "
-                                  "FROM book_to_deliver b "
-                                       "JOIN delivery d ON "
-                                            "b.purchasing_date = d.purchasing_date "
-                                        "AND b.isbn = d.isbn "
-                                        "AND b.customer_id = d.customer_id "
-                                  "WHERE d.courier_id = %1 "
-                                ") h "
-                                  "JOIN book ON "
-                                       "book.isbn = h.isbn "
-                                  "JOIN customer c ON "
-                                       "c.customer_id = h.customer_id"
-                                  ).arg(m_courierID).arg(m_courierID));
+                query.prepare( claimedOrdersQuery( m_courierID ) );
 
+    query.setForwardOnly( true );
     qDebug() << "Exec: " << query.exec();
-    m_selectedModel->setQuery( query );
+    m_selectedModel->load( query );
     qDebug() << m_selectedModel->rowCount();
     m_selectedModel->setHeaderData( 0, Qt::Horizontal, tr("Receive/Deliver"));
     m_selectedModel->setHeaderData( 1, Qt::Horizontal, tr("Date of purchase"));
@@ -322,23 +460,109 @@ void MainWindow::redrawSelected()
     ui->selectedView->hideColumn( 2 ); // customer id
     ui->selectedView->hideColumn( 8 ); // comment
     ui->selectedView->resizeColumnsToContents();
+
+    routeSelected();
+    reportMemory();
+}
+
+QString MainWindow::commentOf(const int row)
+{
+    if (m_selectedModel->isResident( row, 8 )) {
+        return m_selectedModel->value( row, 8 );
+    }
+
+    DBOpener db( this );
+
+    QSqlQuery query;
+    if ( "Deliver" == m_selectedModel->value( row, 0 ) ) {
+        qDebug() << "Prepare: " <<
+                query.prepare( "SELECT commnt FROM book_to_deliver "
+                               "WHERE purchasing_date = to_timestamp(:dt, 'J SSSSS') "
+                                 "AND isbn = :isbn "
+                                 "AND customer_id = :cust"
+                               );
+    }
+    else {
+        qDebug() << "Prepare: " <<
+                query.prepare( "SELECT commnt FROM book_to_receive "
+                               "WHERE purchasing_date = to_timestamp(:dt, 'J SSSSS') "
+                                 "AND isbn = :isbn "
+                                 "AND customer_id = :cust"
+                               );
+    }
+    query.bindValue( ":dt", m_selectedModel->value( row, 1 ));
+    query.bindValue( ":cust", m_selectedModel->value( row, 2 ));
+    query.bindValue( ":isbn", m_selectedModel->value( row, 3 ));
+
+    qDebug() << "Exec: " << query.exec();
+    const QString comment = query.first() ? query.value( 0 ).toString() : QString();
+    m_selectedModel->restore( row, 8, comment );
+    return comment;
+}
+
+void MainWindow::reportMemory()
+{
+    qDebug() << "Memory, KB: available orders" << m_inputModel->usedBytes() / 1024
+             << "(peak" << m_inputModel->peakBytes() / 1024 << ")"
+             << ", claimed orders" << m_selectedModel->usedBytes() / 1024
+             << "(peak" << m_selectedModel->peakBytes() / 1024 << ")"
+             << ", process" << processResidentBytes() / 1024
+             << "(peak" << processPeakResidentBytes() / 1024 << ")";
+
+    if (m_inputModel->isTruncated()) {
+        ui->statusbar->showMessage( tr("Memory budget reached: only %1 available orders are shown")
+                                    .arg( m_inputModel->rowCount() ) );
+    }
+}
+
+void MainWindow::routeSelected()
+{
+    const int rows = m_selectedModel->rowCount();
+
+    // the same order may be both received and delivered by this courier
+    QHash<QString, int> receiveRows;
+    QVector<RouteOptimizer::Stop> stops( rows );
+    for (int row = 0; row < rows; ++row) {
+        if ("Receive" == m_selectedModel->value( row, 0 )) {
+            receiveRows.insert( orderKey( m_selectedModel, row ), row );
+        }
+        stops[row].point = m_geocodes.lookup( m_selectedModel->value( row, 4 ) );
+    }
+    for (int row = 0; row < rows; ++row) {
+        if ("Deliver" == m_selectedModel->value( row, 0 )) {
+            stops[row].after = receiveRows.value( orderKey( m_selectedModel, row ), -1 );
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    RouteOptimizer optimizer;
+    const QVector<int> order = optimizer.plan( m_currentStop, stops );
+    qDebug() << "Route: " << rows << " stops, "
+             << RouteOptimizer::length( m_currentStop, stops, order ) << " km, "
+             << timer.elapsed() << " ms";
+
+    QVector<int> ranks( rows );
+    for (int i = 0; i < order.size(); ++i) {
+        ranks[order[i]] = i;
+    }
+    m_selectedProxy->setRanks( ranks );
 }
 
 void MainWindow::selectBook()
 {
-    const int row = m_inputSelectionModel->currentIndex().row();
+    const int row = m_inputProxy->sourceRow( m_inputSelectionModel->currentIndex() );
 
     if (-1 == row) {
         qDebug() << "No row is selected";
         return;
     }
 
-    const QSqlRecord record = m_inputModel->record( row );
-    const QString customerID = record.value( 2 ).toString();
+    const QString customerID = m_inputModel->value( row, 2 );
     qDebug() << customerID;
-    const QString purchasingDate = record.value( 1 ).toString();
+    const QString purchasingDate = m_inputModel->value( row, 1 );
     qDebug() << purchasingDate;
-    const QString isbn = record.value( 3 ).toString();
+    const QString isbn = m_inputModel->value( row, 3 );
     qDebug() << isbn;
 
     DBOpener dbopener( this );
@@ -368,19 +592,18 @@ void MainWindow::selectBook()
 
 void MainWindow::deselectBook()
 {
-    const int row = m_selectedSelectionModel->currentIndex().row();
+    const int row = m_selectedProxy->sourceRow( m_selectedSelectionModel->currentIndex() );
 
     if (-1 == row) {
         qDebug() << "No row is selected";
         return;
     }
 
-    const QSqlRecord record = m_selectedModel->record( row );
-    const QString customerID = record.value( 2 ).toString();
+    const QString customerID = m_selectedModel->value( row, 2 );
     qDebug() << customerID;
-    const QString purchasingDate = record.value( 1 ).toString();
+    const QString purchasingDate = m_selectedModel->value( row, 1 );
     qDebug() << purchasingDate;
-    const QString isbn = record.value( 3 ).toString();
+    const QString isbn = m_selectedModel->value( row, 3 );
     qDebug() << isbn;
 
     DBOpener dbopener( this );
@@ -408,24 +631,25 @@ void MainWindow::deselectBook()
 
 void MainWindow::markBook()
 {
-    const int row = m_selectedSelectionModel->currentIndex().row();
+    const int row = m_selectedProxy->sourceRow( m_selectedSelectionModel->currentIndex() );
 
     if (-1 == row) {
         qDebug() << "No row is selected";
         return;
     }
 
-    const QSqlRecord record = m_selectedModel->record( row );
-    const QString customerID = record.value( 2 ).toString();
+    const QString customerID = m_selectedModel->value( row, 2 );
     qDebug() << customerID;
-    const QString purchasingDate = record.value( 1 ).toString();
+    const QString purchasingDate = m_selectedModel->value( row, 1 );
     qDebug() << purchasingDate;
-    const QString isbn = record.value( 3 ).toString();
+    const QString isbn = m_selectedModel->value( row, 3 );
     qDebug() << isbn;
 
     DBOpener dbopener( this );
 
     QSqlQuery query;
+    const GeoPoint stop = m_geocodes.lookup( m_selectedModel->value( row, 4 ) );
+
     qDebug() << "Prepare: " <<
                 query.prepare( "CALL courier_mark_book( :isbn, to_timestamp(:dt, 'J SSSSS'), :cust, :cour)" );
 
@@ -442,6 +666,9 @@ void MainWindow::markBook()
         qDebug() << "Rollback: " << QSqlDatabase::database().rollback();
     }
     else {
+        if (stop.valid) { // courier is standing there now
+            m_currentStop = stop;
+        }
         emit updateSelView();
     }
 }
@@ -497,37 +724,83 @@ void MainWindow::processLogin()
 
 
 void MainWindow::setupConnection() const
+{
+    addCourierDatabase();
+}
+
+void MainWindow::setupGeocoding()
+{
+    QSettings settings( "settings.ini", QSettings::IniFormat );
+
+    settings.beginGroup( "geocode" );
+    const QString fileName( settings.value( "file", "geocode.csv" ).toString() );
+    bool latOk = false;
+    bool lonOk = false;
+    const double depotLat( settings.value( "depot_latitude" ).toDouble( &latOk ) );
+    const double depotLon( settings.value( "depot_longitude" ).toDouble( &lonOk ) );
+    m_nearbyRadiusKm = settings.value( "nearby_radius_km", 2.0 ).toDouble();
+    settings.endGroup();
+
+    qDebug() << "geocode file: " << fileName;
+    qDebug() << "depot: " << depotLat << depotLon;
+    qDebug() << "nearby radius: " << m_nearbyRadiusKm;
+
+    m_geocodes.load( fileName );
+    if (latOk && lonOk) {
+        m_depot = GeoPoint( depotLat, depotLon );
+    }
+    m_currentStop = m_depot;
+}
+
+void MainWindow::setupMemoryBudget()
 {
     QSettings settings( "settings.ini", QSettings::IniFormat );
 
-    settings.beginGroup( "database" );
-    const QString dbDriver( settings.value( "driver",   "QOCI"      ).toString() );
-    const QString hostName( settings.value( "hostname", "localhost" ).toString() );
-    const QString dbName( settings.value( "database", "bookstore" ).toString() );
-    const QString userName( settings.value( "user",     QString()   ).toString() );
-    const QString password( settings.value( "password", QString()   ).toString() );
-    const int port( settings.value( "port", "1521").toInt());
+    settings.beginGroup( "memory" );
+    const qint64 budgetKb( settings.value( "budget_kb", 0 ).toLongLong() );
     settings.endGroup();
 
-    qDebug() << "driver: " << dbDriver;
-    qDebug() << "hostname: " << hostName;
-    qDebug() << "database: " << dbName;
-    qDebug() << "username: " << userName;
-    qDebug() << "password: " << password;
-    qDebug() << "port: " << port;
-
-    QSqlDatabase db = QSqlDatabase::addDatabase( dbDriver );
-    db.setHostName(     hostName );
-    db.setDatabaseName( dbName );
-    db.setUserName(     userName );
-    db.setPassword(     password );
-    db.setPort( port );
+    qDebug() << "memory budget, KB: " << budgetKb;
+
+    // available orders usually outnumber claimed ones
+    m_inputModel->setBudget( budgetKb * 1024 * 3 / 4 );
+    m_selectedModel->setBudget( budgetKb * 1024 / 4 );
+    // never hide a courier's own claimed orders, only evict their comments
+    m_selectedModel->setTruncationAllowed( false );
+
+    m_inputModel->setPayloadColumns( QList<int>() << 7 );    // customer's phone, hidden
+    m_selectedModel->setPayloadColumns( QList<int>() << 8 ); // comment, read on selection
+}
+
+void MainWindow::setupExport()
+{
+    QSettings settings( "settings.ini", QSettings::IniFormat );
+
+    settings.beginGroup( "export" );
+    m_exportThreads = settings.value( "threads", QThread::idealThreadCount() ).toInt();
+    // run sheets of all couriers include customers' phones: dispatchers only
+    const QStringList dispatchers( settings.value( "dispatchers" ).toStringList() );
+    settings.endGroup();
+
+    m_dispatcherIDs.clear();
+    for (int i = 0; i < dispatchers.size(); ++i) {
+        bool ok = false;
+        const uint id = dispatchers[i].trimmed().toUInt( &ok );
+        if (ok && 0 != id) {
+            m_dispatcherIDs.append( id );
+        }
+    }
+
+    qDebug() << "export threads: " << m_exportThreads;
+    qDebug() << "dispatchers: " << m_dispatcherIDs;
 }
 
 void MainWindow::disconnectCourier()
 {
     m_inputModel->clear();
     m_selectedModel->clear();
+    m_availableIndex.clear();
+    m_currentStop = m_depot;
     ui->tabWidget->setEnabled( false );
     ui->menuAction->setEnabled( false );
     ui->actionDisconnect->setEnabled( false );
@@ -548,6 +821,7 @@ void MainWindow::connectCourier()
     ui->menuAction->setEnabled( true );
 
     ui->actionDisconnect->setEnabled( true );
+    updateExportActions();
     ui->tabWidget->setCurrentIndex( -1 );
     ui->tabWidget->setCurrentIndex( 0 );
 
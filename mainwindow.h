@@ -1,12 +1,14 @@
 #pragma once
 
 #include <QMainWindow>
+#include "geocodecache.h"
+#include "spatialindex.h"
 
 namespace Ui {
 class MainWindow;
 }
 
-class QSqlQueryModel;
+class OrderTableModel;
 class QButtonGroup;
 class QItemSelectionModel;
 class QStringList;
@@ -15,6 +17,8 @@ class QStringListModel;
 class LoginDialog;
 class QModelIndex;
 class CommentDialog;
+class OrderProxyModel;
+class ManifestExportJob;
 
 class MainWindow : public QMainWindow
 {
@@ -29,16 +33,67 @@ private:
     LoginDialog    *m_login;
     CommentDialog  *m_commentDialog;
     uint            m_courierID;
-    QSqlQueryModel *m_inputModel;
+    OrderTableModel *m_inputModel;
+    OrderProxyModel *m_inputProxy;
     QItemSelectionModel *m_inputSelectionModel;
-    QSqlQueryModel *m_selectedModel;
+    OrderTableModel *m_selectedModel;
+    OrderProxyModel *m_selectedProxy;
     QItemSelectionModel *m_selectedSelectionModel;
+    GeocodeCache    m_geocodes;
+    SpatialIndex    m_availableIndex; // ids are m_inputModel rows
+    GeoPoint        m_depot;
+    GeoPoint        m_currentStop;
+    double          m_nearbyRadiusKm;
+    ManifestExportJob *m_exportJob;
+    QList<uint>     m_dispatcherIDs;
+    int             m_exportThreads;
 
     /**
      * @brief Setup database connection: login, host, etc
      */
     void setupConnection() const;
 
+    /**
+     * @brief Load geocode cache, depot location and "nearby" radius from settings
+     */
+    void setupGeocoding();
+
+    /**
+     * @brief Re-index geocoded rows of m_inputModel after a refresh
+     */
+    void rebuildAvailableIndex();
+
+    /**
+     * @brief Shows claimed orders of m_selectedModel in optimized visiting order
+     */
+    void routeSelected();
+
+    /**
+     * @brief Split [memory] budget_kb from settings between both order tables
+     */
+    void setupMemoryBudget();
+
+    /**
+     * @brief Load export thread count and couriers allowed to export all run sheets
+     */
+    void setupExport();
+
+    /**
+     * @brief Export actions are available unless a bulk export is running;
+     *        exporting all couriers only to dispatchers
+     */
+    void updateExportActions();
+
+    /**
+     * @brief Comment of a claimed order, re-read from database if it was evicted
+     */
+    QString commentOf( int row );
+
+    /**
+     * @brief Logs current and peak memory, warns if an order table hit the budget
+     */
+    void reportMemory();
+
 
     /**
      * @brief Enables all widgets after succesful login of courier
@@ -59,6 +114,19 @@ private slots:
      */
     void disconnectCourier();
     void editComment();
+    /**
+     * @brief Applies "nearest first" mode to tableView and reports orders near current stop
+     */
+    void applyInputOrder();
+    /**
+     * @brief Save run sheet of the logged in courier
+     */
+    void exportManifest();
+    /**
+     * @brief Save run sheets of all couriers into one directory
+     */
+    void exportAllManifests();
+    void manifestsExported( int written, int total );
 signals:
     void updateInputView();
     void updateSelView();
@@ -0,0 +1,285 @@
+#include "manifestexporter.h"
+#include "courierdatabase.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+#include <QFile>
+#include <QDir>
+#include <QDate>
+#include <QTime>
+#include <QStringList>
+#include <QRunnable>
+#include <QMetaObject>
+#include <QDebug>
+
+namespace
+{
+const int bufferSize = 64 * 1024;
+const int columnCount = 9;
+const int dateColumn = 1;
+const char * const columnNames[columnCount] = {
+    "Receive/Deliver", "Date of purchase", "CustomerID", "ISBN", "Address",
+    "Title", "Customer's name", "Customer's phone", "Comment"
+};
+
+/**
+ * @brief Collects small writes and hands them to the file in large blocks
+ */
+class BufferedWriter
+{
+public:
+    explicit BufferedWriter( QFile& file )
+      : m_file( file )
+      , m_ok( true )
+    {
+        m_buffer.reserve( bufferSize );
+    }
+
+    void write( const QByteArray& data )
+    {
+        m_buffer.append( data );
+        if (m_buffer.size() >= bufferSize) {
+            flush();
+        }
+    }
+
+    void write( const char c )
+    {
+        m_buffer.append( c );
+        if (m_buffer.size() >= bufferSize) {
+            flush();
+        }
+    }
+
+    void writeVarint( quint64 value )
+    {
+        while (value >= 0x80) {
+            write( static_cast<char>( (value & 0x7f) | 0x80 ) );
+            value >>= 7;
+        }
+        write( static_cast<char>( value ) );
+    }
+
+    bool flush()
+    {
+        if (!m_buffer.isEmpty()) {
+            m_ok = m_ok && m_file.write( m_buffer ) == m_buffer.size();
+            m_buffer.resize( 0 ); // keeps capacity
+        }
+        return m_ok;
+    }
+
+private:
+    QFile&     m_file;
+    QByteArray m_buffer;
+    bool       m_ok;
+};
+
+/**
+ * @brief 'J SSSSS' (julian day, seconds past midnight) -> readable timestamp
+ */
+QString readableDate( const QString& julian )
+{
+    const int space = julian.indexOf( ' ' );
+    if (-1 == space) {
+        return julian;
+    }
+    const QDate date = QDate::fromJulianDay( julian.left( space ).toInt() );
+    const QTime time = QTime( 0, 0 ).addSecs( julian.mid( space + 1 ).toInt() );
+    return date.toString( "yyyy-MM-dd" ) + ' ' + time.toString( "hh:mm:ss" );
+}
+
+QString field( const QSqlQuery& query, const int column )
+{
+    const QString value = query.value( column ).toString();
+    return dateColumn == column ? readableDate( value ) : value;
+}
+
+QByteArray csvField( const QString& value )
+{
+    QByteArray utf8 = value.toUtf8();
+    if (-1 == utf8.indexOf( ',' ) && -1 == utf8.indexOf( '"' )
+        && -1 == utf8.indexOf( '\n' ) && -1 == utf8.indexOf( '\r' )) {
+        return utf8;
+    }
+    utf8.replace( "\"", "\"\"" );
+    return '"' + utf8 + '"';
+}
+
+void writeString( BufferedWriter& out, const QString& value )
+{
+    const QByteArray utf8 = value.toUtf8();
+    out.writeVarint( utf8.size() );
+    out.write( utf8 );
+}
+
+int writeCsv( QSqlQuery& query, BufferedWriter& out )
+{
+    out.write( QByteArray( "\xEF\xBB\xBF" ) ); // BOM, spreadsheets otherwise guess the encoding
+    for (int column = 0; column < columnCount; ++column) {
+        if (column > 0) {
+            out.write( ',' );
+        }
+        out.write( csvField( columnNames[column] ) );
+    }
+    out.write( QByteArray( "\r\n" ) );
+
+    int rows = 0;
+    while (query.next()) {
+        for (int column = 0; column < columnCount; ++column) {
+            if (column > 0) {
+                out.write( ',' );
+            }
+            out.write( csvField( field( query, column ) ) );
+        }
+        out.write( QByteArray( "\r\n" ) );
+        ++rows;
+    }
+    return rows;
+}
+
+int writeBinary( QSqlQuery& query, BufferedWriter& out, const uint courierID )
+{
+    out.write( QByteArray( "DCM" ) );
+    out.write( static_cast<char>( 1 ) ); // version
+    out.writeVarint( courierID );
+    out.writeVarint( columnCount );
+    for (int column = 0; column < columnCount; ++column) {
+        writeString( out, columnNames[column] );
+    }
+
+    int rows = 0;
+    while (query.next()) {
+        out.write( static_cast<char>( 1 ) );
+        for (int column = 0; column < columnCount; ++column) {
+            writeString( out, field( query, column ) );
+        }
+        ++rows;
+    }
+
+    out.write( static_cast<char>( 0 ) );
+    out.writeVarint( rows );
+    return rows;
+}
+
+class ExportTask : public QRunnable
+{
+public:
+    ExportTask( const uint courierID, const QString& fileName,
+                const ManifestExporter::Format format, QObject * const job )
+      : m_courierID( courierID )
+      , m_fileName( fileName )
+      , m_format( format )
+      , m_job( job )
+    {
+    }
+
+    void run()
+    {
+        const QString connection = QString( "manifest_%1" ).arg( m_courierID );
+        bool ok = false;
+        {
+            QSqlDatabase db = addCourierDatabase( connection );
+            if (db.open()) {
+                ok = ManifestExporter::exportCourier( db, m_courierID, m_fileName, m_format );
+                db.close();
+            }
+            else {
+                qDebug() << "Manifest connection: " << db.lastError();
+            }
+        }
+        QSqlDatabase::removeDatabase( connection );
+
+        QMetaObject::invokeMethod( m_job, "taskFinished", Qt::QueuedConnection, Q_ARG( bool, ok ) );
+    }
+
+private:
+    const uint                     m_courierID;
+    const QString                  m_fileName;
+    const ManifestExporter::Format m_format;
+    QObject * const                m_job;
+};
+}
+
+QString ManifestExporter::suffix(const Format format)
+{
+    return Csv == format ? "csv" : "dcm";
+}
+
+QString ManifestExporter::fileName(const QString &directory, const uint courierID, const Format format)
+{
+    return QDir( directory ).filePath( QString( "manifest_%1.%2" ).arg( courierID ).arg( suffix( format ) ) );
+}
+
+bool ManifestExporter::exportCourier(const QSqlDatabase &db, const uint courierID,
+                                     const QString &fileName, const Format format)
+{
+    QSqlQuery query( db );
+    query.setForwardOnly( true ); // rows are not cached by the driver
+    if (!query.prepare( claimedOrdersQuery( courierID ) ) || !query.exec()) {
+        qDebug() << "Manifest query: " << query.lastError();
+        return false;
+    }
+
+    QFile file( fileName );
+    if (!file.open( QIODevice::WriteOnly | QIODevice::Truncate )) {
+        qDebug() << "Manifest file: " << fileName << file.errorString();
+        return false;
+    }
+
+    BufferedWriter out( file );
+    const int rows = Csv == format ? writeCsv( query, out )
+                                   : writeBinary( query, out, courierID );
+    const bool ok = out.flush() && query.lastError().type() == QSqlError::NoError;
+    qDebug() << "Manifest: " << fileName << rows << " orders, ok: " << ok;
+    return ok;
+}
+
+ManifestExportJob::ManifestExportJob(QObject *parent)
+  : QObject(parent)
+  , m_pending( 0 )
+  , m_written( 0 )
+  , m_total( 0 )
+{
+}
+
+ManifestExportJob::~ManifestExportJob()
+{
+    // tasks refer to this object, let them finish first
+    m_pool.waitForDone();
+}
+
+void ManifestExportJob::start(const QList<uint> &courierIDs, const QString &directory,
+                              const ManifestExporter::Format format, const int threads)
+{
+    if (isRunning()) {
+        qDebug() << "Manifest export is already running";
+        return;
+    }
+
+    m_pending = courierIDs.size();
+    m_written = 0;
+    m_total = courierIDs.size();
+    if (0 == m_total) {
+        emit finished( 0, 0 );
+        return;
+    }
+
+    m_pool.setMaxThreadCount( qMax( 1, threads ) );
+    for (int i = 0; i < courierIDs.size(); ++i) {
+        const uint courierID = courierIDs[i];
+        m_pool.start( new ExportTask( courierID, ManifestExporter::fileName( directory, courierID, format ),
+                                      format, this ) );
+    }
+}
+
+void ManifestExportJob::taskFinished(const bool ok)
+{
+    if (ok) {
+        ++m_written;
+    }
+    if (0 == --m_pending) {
+        emit finished( m_written, m_total );
+    }
+}
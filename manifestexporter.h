@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+class QSqlDatabase;
+
+/**
+ * @brief Writes couriers' run sheets (claimed orders) to files.
+ *
+ * Rows are streamed from a forward-only query straight into a write buffer,
+ * so memory use does not depend on the number of orders.
+ *
+ * Binary manifest (.dcm) layout, integers are LEB128 varints,
+ * strings are varint byte length + UTF-8:
+ *   "DCM" magic, version byte (1), courier id, column count, column names,
+ *   then per order a 0x01 tag and one string per column,
+ *   then a 0x00 tag and the number of orders written.
+ */
+class ManifestExporter
+{
+public:
+    enum Format
+    {
+        Csv,
+        Binary
+    };
+
+    /**
+     * @brief File extension for format, without dot
+     */
+    static QString suffix( Format format );
+
+    /**
+     * @brief Default file name of courierID's manifest inside directory
+     */
+    static QString fileName( const QString& directory, uint courierID, Format format );
+
+    /**
+     * @brief Streams claimed orders of courierID to fileName through db (must be open)
+     * @return false on query or file error
+     */
+    static bool exportCourier( const QSqlDatabase& db, uint courierID, const QString& fileName, Format format );
+};
+
+/**
+ * @brief Exports manifests of many couriers in background threads.
+ * Each worker opens its own database connection; finished() is delivered
+ * in the thread of the job, so the GUI stays responsive meanwhile.
+ */
+class ManifestExportJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ManifestExportJob(QObject *parent = NULL);
+    ~ManifestExportJob();
+
+    /**
+     * @brief Starts exporting courierIDs to directory, up to threads at a time.
+     * Returns at once; ignored while a previous export is running.
+     */
+    void start( const QList<uint>& courierIDs, const QString& directory,
+                ManifestExporter::Format format, int threads );
+
+    bool isRunning() const { return m_pending > 0; }
+
+signals:
+    void finished( int written, int total );
+
+private slots:
+    void taskFinished( bool ok );
+
+private:
+    QThreadPool m_pool;
+    int         m_pending;
+    int         m_written;
+    int         m_total;
+};
@@ -0,0 +1,63 @@
+#include "memorystats.h"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <QFile>
+#include <QByteArray>
+#endif
+
+namespace
+{
+#if defined(Q_OS_WIN)
+qint64 workingSet( const bool peak )
+{
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) )) {
+        return -1;
+    }
+    return peak ? counters.PeakWorkingSetSize : counters.WorkingSetSize;
+}
+#else
+/**
+ * @brief Value of a "Name:   1234 kB" line of /proc/self/status (Linux)
+ */
+qint64 statusKilobytes( const QByteArray& name )
+{
+    QFile status( "/proc/self/status" );
+    if (!status.open( QIODevice::ReadOnly )) {
+        return -1;
+    }
+
+    while (!status.atEnd()) {
+        const QByteArray line = status.readLine();
+        if (line.startsWith( name )) {
+            const QByteArray number = line.mid( name.size() ).trimmed().split( ' ' ).value( 0 );
+            bool ok = false;
+            const qint64 kb = number.toLongLong( &ok );
+            return ok ? kb * 1024 : -1;
+        }
+    }
+    return -1;
+}
+#endif
+}
+
+qint64 processResidentBytes()
+{
+#if defined(Q_OS_WIN)
+    return workingSet( false );
+#else
+    return statusKilobytes( "VmRSS:" );
+#endif
+}
+
+qint64 processPeakResidentBytes()
+{
+#if defined(Q_OS_WIN)
+    return workingSet( true );
+#else
+    return statusKilobytes( "VmHWM:" );
+#endif
+}
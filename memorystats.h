@@ -0,0 +1,13 @@
+#pragma once
+
+#include <QtGlobal>
+
+/**
+ * @brief Resident memory of this process, in bytes. -1 if the OS does not tell.
+ */
+qint64 processResidentBytes();
+
+/**
+ * @brief Peak resident memory of this process, in bytes. -1 if the OS does not tell.
+ */
+qint64 processPeakResidentBytes();
@@ -0,0 +1,41 @@
+#include "orderproxymodel.h"
+#include <climits>
+
+OrderProxyModel::OrderProxyModel(QObject *parent)
+  : QSortFilterProxyModel(parent)
+{
+    setDynamicSortFilter( false );
+}
+
+void OrderProxyModel::setRanks(const QVector<int> &ranks)
+{
+    m_ranks = ranks;
+    invalidate();
+    sort( 0 );
+}
+
+void OrderProxyModel::clearRanks()
+{
+    m_ranks.clear();
+    sort( -1 );
+}
+
+int OrderProxyModel::sourceRow(const QModelIndex &proxyIndex) const
+{
+    return mapToSource( proxyIndex ).row();
+}
+
+int OrderProxyModel::rankOf(const int sourceRow) const
+{
+    return sourceRow < m_ranks.size() ? m_ranks[sourceRow] : INT_MAX;
+}
+
+bool OrderProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    const int leftRank = rankOf( left.row() );
+    const int rightRank = rankOf( right.row() );
+    if (leftRank != rightRank) {
+        return leftRank < rightRank;
+    }
+    return left.row() < right.row();
+}
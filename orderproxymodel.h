@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QSortFilterProxyModel>
+#include <QVector>
+
+/**
+ * @brief Presents source rows in an externally computed order
+ *        (nearest first, route order) without touching the SQL.
+ */
+class OrderProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit OrderProxyModel(QObject *parent = NULL);
+
+    /**
+     * @brief Shows source rows by ascending ranks[sourceRow].
+     * Rows without a rank (or with equal ranks) keep database order.
+     */
+    void setRanks( const QVector<int>& ranks );
+
+    /**
+     * @brief Returns to database order
+     */
+    void clearRanks();
+
+    /**
+     * @brief Source model row shown at proxy index, -1 if none
+     */
+    int sourceRow( const QModelIndex& proxyIndex ) const;
+
+protected:
+    bool lessThan( const QModelIndex& left, const QModelIndex& right ) const;
+
+private:
+    int rankOf( const int sourceRow ) const;
+
+    QVector<int> m_ranks;
+};
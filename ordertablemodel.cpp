@@ -0,0 +1,201 @@
+#include "ordertablemodel.h"
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QVariant>
+#include <climits>
+
+namespace
+{
+const int arenaBlockChars = 4 * 1024; // 8 KB, fine-grained enough for small budgets
+
+int payloadCost( const QString& value )
+{
+    return value.size() * sizeof( QChar ) + sizeof( QString ) + 16; // + allocation header
+}
+}
+
+OrderTableModel::OrderTableModel(QObject *parent)
+  : QAbstractTableModel(parent)
+  , m_arena( arenaBlockChars )
+  , m_rows( 0 )
+  , m_columns( 0 )
+  , m_budget( 0 )
+  , m_peakBytes( 0 )
+  , m_truncationAllowed( true )
+  , m_truncated( false )
+{
+    m_payloads.setMaxCost( INT_MAX );
+}
+
+void OrderTableModel::setPayloadColumns(const QList<int> &columns)
+{
+    m_payloadColumns = columns;
+}
+
+void OrderTableModel::setBudget(const qint64 bytes)
+{
+    m_budget = bytes;
+    updateBudget();
+}
+
+void OrderTableModel::setTruncationAllowed(const bool allowed)
+{
+    m_truncationAllowed = allowed;
+}
+
+qint64 OrderTableModel::storedBytes() const
+{
+    // only what the current contents occupy: blocks and capacity kept for reuse don't count
+    return m_arena.usedBytes() + qint64( m_cells.size() ) * sizeof( RowArena::Ref );
+}
+
+qint64 OrderTableModel::usedBytes() const
+{
+    return m_arena.allocatedBytes() + qint64( m_cells.capacity() ) * sizeof( RowArena::Ref )
+         + m_payloads.totalCost();
+}
+
+void OrderTableModel::updateBudget()
+{
+    if (m_budget > 0) {
+        // payloads get whatever keys and display columns leave, least recently used go first
+        m_payloads.setMaxCost( static_cast<int>( qBound( qint64( 0 ), m_budget - storedBytes(), qint64( INT_MAX ) ) ) );
+    }
+    else {
+        m_payloads.setMaxCost( INT_MAX );
+    }
+    m_peakBytes = qMax( m_peakBytes, usedBytes() );
+}
+
+void OrderTableModel::load(QSqlQuery &query)
+{
+    beginResetModel();
+
+    m_arena.reset();
+    m_cells.resize( 0 );
+    m_payloads.clear();
+    m_rows = 0;
+    m_truncated = false;
+    m_columns = query.record().count();
+    m_isPayload.fill( false, m_columns );
+    for (int i = 0; i < m_payloadColumns.size(); ++i) {
+        if (m_payloadColumns[i] >= 0 && m_payloadColumns[i] < m_columns) {
+            m_isPayload[m_payloadColumns[i]] = true;
+        }
+    }
+
+    while (query.next()) {
+        if (m_truncationAllowed && m_budget > 0 && storedBytes() > m_budget) {
+            m_truncated = true;
+            break;
+        }
+
+        for (int column = 0; column < m_columns; ++column) {
+            const QString text = query.value( column ).toString();
+            if (m_isPayload[column]) {
+                // empty payloads are cached too: only a real eviction sends commentOf() to the database
+                m_cells.append( RowArena::Ref() );
+                m_payloads.insert( m_rows * m_columns + column, new QString( text ), payloadCost( text ) );
+            }
+            else {
+                m_cells.append( m_arena.store( text ) );
+            }
+        }
+        ++m_rows;
+        updateBudget();
+    }
+
+    m_arena.trim();
+    m_cells.squeeze();
+    updateBudget();
+
+    endResetModel();
+}
+
+void OrderTableModel::clear()
+{
+    beginResetModel();
+    m_arena.reset();
+    m_arena.trim();
+    m_cells.clear();
+    m_payloads.clear();
+    m_headers.clear();
+    m_rows = 0;
+    m_columns = 0;
+    m_truncated = false;
+    endResetModel();
+}
+
+QString OrderTableModel::value(const int row, const int column) const
+{
+    if (row < 0 || row >= m_rows || column < 0 || column >= m_columns) {
+        return QString();
+    }
+
+    if (m_isPayload[column]) {
+        const QString * const payload = m_payloads.object( row * m_columns + column );
+        return payload ? *payload : QString();
+    }
+    return m_arena.value( m_cells[row * m_columns + column] );
+}
+
+bool OrderTableModel::isResident(const int row, const int column) const
+{
+    if (row < 0 || row >= m_rows || column < 0 || column >= m_columns) {
+        return false;
+    }
+    return !m_isPayload[column] || m_payloads.contains( row * m_columns + column );
+}
+
+void OrderTableModel::restore(const int row, const int column, const QString &value)
+{
+    if (row < 0 || row >= m_rows || column < 0 || column >= m_columns || !m_isPayload[column]) {
+        return;
+    }
+
+    m_payloads.insert( row * m_columns + column, new QString( value ), payloadCost( value ) );
+    updateBudget();
+    emit dataChanged( index( row, column ), index( row, column ) );
+}
+
+int OrderTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows;
+}
+
+int OrderTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_columns;
+}
+
+QVariant OrderTableModel::data(const QModelIndex &index, const int role) const
+{
+    if (!index.isValid() || (Qt::DisplayRole != role && Qt::EditRole != role)) {
+        return QVariant();
+    }
+    return value( index.row(), index.column() );
+}
+
+QVariant OrderTableModel::headerData(const int section, const Qt::Orientation orientation, const int role) const
+{
+    if (Qt::Horizontal == orientation && (Qt::DisplayRole == role || Qt::EditRole == role)
+        && section >= 0 && section < m_headers.size() && m_headers[section].isValid()) {
+        return m_headers[section];
+    }
+    return QAbstractTableModel::headerData( section, orientation, role );
+}
+
+bool OrderTableModel::setHeaderData(const int section, const Qt::Orientation orientation,
+                                    const QVariant &value, const int role)
+{
+    if (Qt::Horizontal != orientation || (Qt::DisplayRole != role && Qt::EditRole != role) || section < 0) {
+        return false;
+    }
+
+    if (section >= m_headers.size()) {
+        m_headers.resize( section + 1 );
+    }
+    m_headers[section] = value;
+    emit headerDataChanged( orientation, section, section );
+    return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "rowarena.h"
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QVector>
+
+class QSqlQuery;
+
+/**
+ * @brief Read-only table of orders with bounded memory use.
+ *
+ * Key and display columns live in a RowArena. Payload columns (hidden,
+ * rarely read) are kept in an LRU cache limited to what the budget leaves
+ * after the arena; evicted payloads read as empty until restore().
+ * When keys and display columns alone exceed the budget, loading stops,
+ * unless truncation is disabled for the table.
+ */
+class OrderTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit OrderTableModel(QObject *parent = NULL);
+
+    void setPayloadColumns( const QList<int>& columns );
+
+    /**
+     * @brief Cap for resident row data in bytes, 0 means unlimited
+     */
+    void setBudget( qint64 bytes );
+
+    /**
+     * @brief Whether load() may drop rows over the budget (default), or only payloads
+     */
+    void setTruncationAllowed( bool allowed );
+
+    /**
+     * @brief Replaces contents with rows of an executed forward-only query
+     */
+    void load( QSqlQuery& query );
+    void clear();
+
+    /**
+     * @brief Cell text without QVariant/QSqlRecord copies, empty if evicted
+     */
+    QString value( int row, int column ) const;
+
+    bool isResident( int row, int column ) const;
+
+    /**
+     * @brief Puts a re-read payload back into the cache
+     */
+    void restore( int row, int column, const QString& value );
+
+    /**
+     * @brief True if the last load() stopped at the budget
+     */
+    bool isTruncated() const { return m_truncated; }
+
+    qint64 usedBytes() const;
+    qint64 peakBytes() const { return m_peakBytes; }
+
+    int rowCount( const QModelIndex& parent = QModelIndex() ) const;
+    int columnCount( const QModelIndex& parent = QModelIndex() ) const;
+    QVariant data( const QModelIndex& index, int role = Qt::DisplayRole ) const;
+    QVariant headerData( int section, Qt::Orientation orientation, int role = Qt::DisplayRole ) const;
+    bool setHeaderData( int section, Qt::Orientation orientation, const QVariant& value, int role = Qt::EditRole );
+
+private:
+    qint64 storedBytes() const;
+    void updateBudget();
+
+    RowArena                     m_arena;
+    QVector<RowArena::Ref>       m_cells; // row * m_columns + column, payload cells unused
+    mutable QCache<int, QString> m_payloads;
+    QVector<bool>                m_isPayload;
+    QList<int>                   m_payloadColumns;
+    QVector<QVariant>            m_headers;
+    int                          m_rows;
+    int                          m_columns;
+    qint64                       m_budget;
+    qint64                       m_peakBytes;
+    bool                         m_truncationAllowed;
+    bool                         m_truncated;
+};
@@ -0,0 +1,356 @@
+#include "routeoptimizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+const int    maxNeighbours = 10;
+const int    maxRounds     = 50;
+const int    maxSegment    = 3;  // Or-opt moves chains of 1..3 stops
+const double epsilon       = 1e-9;
+}
+
+RouteOptimizer::RouteOptimizer()
+  : m_nodes( 0 )
+  , m_hasStart( false )
+  , m_neighbourCount( 0 )
+{
+}
+
+double RouteOptimizer::distance(const int a, const int b) const
+{
+    if (!m_hasStart && (m_nodes == a || m_nodes == b)) {
+        return 0.0;
+    }
+    return std::sqrt( squaredDistance( m_points[a], m_points[b] ) );
+}
+
+QVector<int> RouteOptimizer::plan(const GeoPoint &start, const QVector<Stop> &stops)
+{
+    // a stop is routable if it and everything it depends on has coordinates
+    QVector<bool> routable( stops.size() );
+    for (int i = 0; i < stops.size(); ++i) {
+        routable[i] = stops[i].point.valid;
+    }
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (int i = 0; i < stops.size(); ++i) {
+            const int after = stops[i].after;
+            if (routable[i] && -1 != after && !routable[after]) {
+                routable[i] = false;
+                changed = true;
+            }
+        }
+    }
+
+    QVector<int> stopOf;
+    QVector<int> nodeOf( stops.size(), -1 );
+    double latitudeSum = 0.0;
+    for (int i = 0; i < stops.size(); ++i) {
+        if (routable[i]) {
+            nodeOf[i] = stopOf.size();
+            stopOf.append( i );
+            latitudeSum += stops[i].point.latitude;
+        }
+    }
+
+    m_nodes = stopOf.size();
+    m_hasStart = start.valid;
+    m_points.resize( m_nodes + 1 );
+    m_before.fill( -1, m_nodes + 1 );
+    const double refLatitude = m_nodes > 0 ? latitudeSum / m_nodes : start.latitude;
+    for (int node = 0; node < m_nodes; ++node) {
+        const Stop& stop = stops[stopOf[node]];
+        m_points[node] = toPlane( stop.point, refLatitude );
+        if (-1 != stop.after) {
+            m_before[node] = nodeOf[stop.after];
+        }
+    }
+    m_points[m_nodes] = toPlane( start, refLatitude );
+
+    m_tour.clear();
+    if (m_nodes > 0) {
+        QVector<SpatialIndex::Entry> entries( m_nodes );
+        for (int node = 0; node < m_nodes; ++node) {
+            entries[node].id = node;
+            entries[node].point = stops[stopOf[node]].point;
+        }
+        buildNeighbours( entries );
+        nearestNeighbourTour();
+        for (int round = 0; round < maxRounds; ++round) {
+            const bool twoOpt = twoOptPass();
+            const bool orOpt = orOptPass();
+            if (!twoOpt && !orOpt) {
+                break;
+            }
+        }
+    }
+
+    QVector<int> order;
+    order.reserve( stops.size() );
+    for (int i = 1; i < m_tour.size(); ++i) {
+        order.append( stopOf[m_tour[i]] );
+    }
+
+    // the rest keeps input order, pulling each stop's prerequisites in front of it
+    QVector<bool> placed( routable );
+    for (int i = 0; i < stops.size(); ++i) {
+        QVector<int> chain;
+        for (int s = i; -1 != s && !placed[s]; s = stops[s].after) {
+            placed[s] = true;
+            chain.append( s );
+        }
+        for (int c = chain.size() - 1; c >= 0; --c) {
+            order.append( chain[c] );
+        }
+    }
+    return order;
+}
+
+double RouteOptimizer::length(const GeoPoint &start, const QVector<Stop> &stops, const QVector<int> &order)
+{
+    GeoPoint previous = start;
+    double refLatitude = start.latitude;
+    if (!start.valid && !order.isEmpty()) {
+        refLatitude = stops[order.first()].point.latitude;
+    }
+
+    double total = 0.0;
+    for (int i = 0; i < order.size(); ++i) {
+        const GeoPoint& point = stops[order[i]].point;
+        if (!point.valid) {
+            continue;
+        }
+        if (previous.valid) {
+            total += std::sqrt( squaredDistance( toPlane( previous, refLatitude ),
+                                                 toPlane( point, refLatitude ) ) );
+        }
+        previous = point;
+    }
+    return total;
+}
+
+void RouteOptimizer::buildNeighbours(const QVector<SpatialIndex::Entry> &entries)
+{
+    SpatialIndex index;
+    index.rebuild( entries );
+
+    m_neighbourCount = std::min( maxNeighbours, m_nodes - 1 );
+    m_neighbours.fill( -1, m_nodes * m_neighbourCount );
+    for (int node = 0; node < m_nodes; ++node) {
+        const QVector<SpatialIndex::Hit> hits = index.nearest( entries[node].point, m_neighbourCount + 1 );
+        int slot = node * m_neighbourCount;
+        for (int h = 0; h < hits.size() && slot < (node + 1) * m_neighbourCount; ++h) {
+            if (hits[h].id != node) {
+                m_neighbours[slot++] = hits[h].id;
+            }
+        }
+    }
+}
+
+void RouteOptimizer::nearestNeighbourTour()
+{
+    m_tour.resize( 0 );
+    m_tour.reserve( m_nodes + 1 );
+    m_tour.append( m_nodes );
+
+    QVector<bool> visited( m_nodes + 1, false );
+    visited[m_nodes] = true;
+
+    for (int step = 0; step < m_nodes; ++step) {
+        const int current = m_tour.last();
+        int best = -1;
+        int fallback = -1;
+        double bestDistance = 0.0;
+        for (int node = 0; node < m_nodes; ++node) {
+            if (visited[node]) {
+                continue;
+            }
+            fallback = node;
+            if (-1 != m_before[node] && !visited[m_before[node]]) {
+                continue;
+            }
+            const double d = distance( current, node );
+            if (-1 == best || d < bestDistance) {
+                best = node;
+                bestDistance = d;
+            }
+        }
+        if (-1 == best) { // only possible with cyclic constraints
+            best = fallback;
+        }
+        visited[best] = true;
+        m_tour.append( best );
+    }
+
+    m_position.resize( m_tour.size() );
+    for (int i = 0; i < m_tour.size(); ++i) {
+        m_position[m_tour[i]] = i;
+    }
+}
+
+bool RouteOptimizer::canReverse(const int from, const int to) const
+{
+    for (int i = from; i <= to; ++i) {
+        const int before = m_before[m_tour[i]];
+        if (-1 != before && m_position[before] >= from && m_position[before] <= to) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RouteOptimizer::reverse(const int from, const int to)
+{
+    std::reverse( m_tour.begin() + from, m_tour.begin() + to + 1 );
+    for (int i = from; i <= to; ++i) {
+        m_position[m_tour[i]] = i;
+    }
+}
+
+bool RouteOptimizer::twoOptPass()
+{
+    const int last = m_nodes;
+    bool improved = false;
+
+    for (int node = 0; node < m_nodes; ++node) {
+        for (int n = 0; n < m_neighbourCount; ++n) {
+            const int other = m_neighbours[node * m_neighbourCount + n];
+            if (-1 == other) {
+                break;
+            }
+
+            // reversing m_tour[from..to] makes node and other adjacent
+            const int i = m_position[node];
+            const int j = m_position[other];
+            int from;
+            int to;
+            if (j > i + 1) {
+                from = i + 1;
+                to = j;
+            }
+            else if (j < i - 1 && j >= 1) {
+                from = j;
+                to = i - 1;
+            }
+            else {
+                continue;
+            }
+
+            double delta = distance( m_tour[from - 1], m_tour[to] )
+                         - distance( m_tour[from - 1], m_tour[from] );
+            if (to < last) {
+                delta += distance( m_tour[from], m_tour[to + 1] )
+                       - distance( m_tour[to], m_tour[to + 1] );
+            }
+
+            if (delta < -epsilon && canReverse( from, to )) {
+                reverse( from, to );
+                improved = true;
+            }
+        }
+    }
+    return improved;
+}
+
+bool RouteOptimizer::canMove(const int from, const int to, const int after) const
+{
+    if (after > to) { // stops in (to, after] end up in front of the segment
+        for (int i = to + 1; i <= after; ++i) {
+            const int before = m_before[m_tour[i]];
+            if (-1 != before && m_position[before] >= from && m_position[before] <= to) {
+                return false;
+            }
+        }
+    }
+    else { // stops in (after, from) end up behind the segment
+        for (int i = from; i <= to; ++i) {
+            const int before = m_before[m_tour[i]];
+            if (-1 != before && m_position[before] > after && m_position[before] < from) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void RouteOptimizer::move(const int from, const int to, const int after)
+{
+    const int first = std::min( from, after + 1 );
+    const int last = std::max( to, after );
+
+    QVector<int> moved;
+    moved.reserve( last - first + 1 );
+    if (after > to) {
+        for (int i = to + 1; i <= after; ++i) {
+            moved.append( m_tour[i] );
+        }
+        for (int i = from; i <= to; ++i) {
+            moved.append( m_tour[i] );
+        }
+    }
+    else {
+        for (int i = from; i <= to; ++i) {
+            moved.append( m_tour[i] );
+        }
+        for (int i = after + 1; i < from; ++i) {
+            moved.append( m_tour[i] );
+        }
+    }
+
+    for (int i = first; i <= last; ++i) {
+        m_tour[i] = moved[i - first];
+        m_position[m_tour[i]] = i;
+    }
+}
+
+bool RouteOptimizer::orOptPass()
+{
+    const int last = m_nodes;
+    bool improved = false;
+
+    for (int from = 1; from <= last; ++from) {
+        for (int length = 1; length <= maxSegment && from + length - 1 <= last; ++length) {
+            const int to = from + length - 1;
+            const int head = m_tour[from];
+            const int tail = m_tour[to];
+            const int prev = m_tour[from - 1];
+
+            double removeGain = distance( prev, head );
+            if (to < last) {
+                removeGain += distance( tail, m_tour[to + 1] ) - distance( prev, m_tour[to + 1] );
+            }
+
+            // insert after a neighbour of head, or before a neighbour of tail
+            bool moved = false;
+            for (int n = 0; n < 2 * m_neighbourCount && !moved; ++n) {
+                const bool afterNeighbour = n < m_neighbourCount;
+                const int end = afterNeighbour ? head : tail;
+                const int other = m_neighbours[end * m_neighbourCount + n % m_neighbourCount];
+                if (-1 == other) {
+                    continue;
+                }
+                const int after = afterNeighbour ? m_position[other] : m_position[other] - 1;
+                if (after >= from - 1 && after <= to) {
+                    continue;
+                }
+
+                double insertCost = distance( m_tour[after], head );
+                if (after < last) {
+                    insertCost += distance( tail, m_tour[after + 1] )
+                                - distance( m_tour[after], m_tour[after + 1] );
+                }
+
+                if (insertCost - removeGain < -epsilon && canMove( from, to, after )) {
+                    move( from, to, after );
+                    moved = true;
+                    improved = true;
+                }
+            }
+            if (moved) {
+                break;
+            }
+        }
+    }
+    return improved;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "spatialindex.h"
+#include <QVector>
+
+/**
+ * @brief Orders a courier's stops into a short open route.
+ *
+ * Nearest-neighbour construction followed by 2-opt and Or-opt improvement
+ * restricted to each stop's nearest neighbours. Precedence constraints
+ * (a receive before its matching deliver) hold for every intermediate route.
+ */
+class RouteOptimizer
+{
+public:
+    struct Stop
+    {
+        Stop() : after( -1 ) {}
+
+        GeoPoint point;
+        int      after; // index of the stop that must be visited earlier, -1 if none
+    };
+
+    RouteOptimizer();
+
+    /**
+     * @brief Visiting order of stops, as indices into stops.
+     * Stops without coordinates (or depending on one) go last, in input order.
+     * @param start where the courier is now; invalid means "anywhere"
+     */
+    QVector<int> plan( const GeoPoint& start, const QVector<Stop>& stops );
+
+    /**
+     * @brief Length in km of visiting stops in order, starting from start
+     */
+    static double length( const GeoPoint& start, const QVector<Stop>& stops, const QVector<int>& order );
+
+private:
+    double distance( int a, int b ) const;
+    bool canReverse( int from, int to ) const;
+    bool canMove( int from, int to, int after ) const;
+    void reverse( int from, int to );
+    void move( int from, int to, int after );
+    void buildNeighbours( const QVector<SpatialIndex::Entry>& entries );
+    void nearestNeighbourTour();
+    bool twoOptPass();
+    bool orOptPass();
+
+    // routable stops are nodes 0..n-1, node n is the fixed start at tour position 0
+    int                  m_nodes;
+    bool                 m_hasStart;
+    QVector<PlanarPoint> m_points;
+    QVector<int>         m_before;     // node that must precede, -1 if none
+    QVector<int>         m_neighbours; // m_neighbourCount per node, nearest first
+    int                  m_neighbourCount;
+    QVector<int>         m_tour;
+    QVector<int>         m_position;
+};
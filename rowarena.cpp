@@ -0,0 +1,87 @@
+#include "rowarena.h"
+#include <cstring>
+
+RowArena::RowArena(const int blockChars)
+  : m_blockChars( blockChars )
+  , m_current( -1 )
+  , m_used( 0 )
+  , m_storedChars( 0 )
+  , m_allocatedBytes( 0 )
+{
+}
+
+RowArena::~RowArena()
+{
+    for (int i = 0; i < m_blocks.size(); ++i) {
+        delete [] m_blocks[i];
+    }
+}
+
+void RowArena::nextBlock(const int minChars)
+{
+    ++m_current;
+    m_used = 0;
+    if (m_current < m_blocks.size() && m_sizes[m_current] >= minChars) {
+        return;
+    }
+
+    // oversized strings get a block of their own, placed before reusable ones
+    const int size = qMax( m_blockChars, minChars );
+    m_blocks.insert( m_current, new QChar[size] );
+    m_sizes.insert( m_current, size );
+    m_allocatedBytes += qint64( size ) * sizeof( QChar );
+}
+
+RowArena::Ref RowArena::store(const QString &value)
+{
+    Ref ref;
+    ref.length = value.size();
+    if (0 == ref.length) {
+        return ref;
+    }
+
+    if (-1 == m_current || m_used + ref.length > m_sizes[m_current]) {
+        nextBlock( ref.length );
+    }
+
+    ref.block = m_current;
+    ref.offset = m_used;
+    memcpy( m_blocks[m_current] + m_used, value.constData(), ref.length * sizeof( QChar ) );
+    m_used += ref.length;
+    m_storedChars += ref.length;
+    return ref;
+}
+
+QString RowArena::value(const Ref &ref) const
+{
+    if (0 == ref.length) {
+        return QString();
+    }
+    return QString( m_blocks[ref.block] + ref.offset, ref.length );
+}
+
+void RowArena::reset()
+{
+    // oversized blocks would be reused only by chance, give them back
+    for (int i = m_blocks.size() - 1; i >= 0; --i) {
+        if (m_sizes[i] > m_blockChars) {
+            m_allocatedBytes -= qint64( m_sizes[i] ) * sizeof( QChar );
+            delete [] m_blocks[i];
+            m_blocks.remove( i );
+            m_sizes.remove( i );
+        }
+    }
+    m_current = -1;
+    m_used = 0;
+    m_storedChars = 0;
+}
+
+void RowArena::trim()
+{
+    while (m_blocks.size() > m_current + 1) {
+        m_allocatedBytes -= qint64( m_sizes.last() ) * sizeof( QChar );
+        delete [] m_blocks.last();
+        m_blocks.remove( m_blocks.size() - 1 );
+        m_sizes.remove( m_sizes.size() - 1 );
+    }
+}
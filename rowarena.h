@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Bump allocator for row strings.
+ *
+ * Strings are copied into large fixed-size blocks instead of one heap
+ * allocation each. reset() keeps the blocks for the next refresh, so a
+ * long-running session reuses the same memory instead of fragmenting it.
+ */
+class RowArena
+{
+public:
+    struct Ref
+    {
+        Ref() : block( 0 ), offset( 0 ), length( 0 ) {}
+
+        int block;
+        int offset;
+        int length;
+    };
+
+    explicit RowArena( int blockChars = 32 * 1024 );
+    ~RowArena();
+
+    Ref store( const QString& value );
+    QString value( const Ref& ref ) const;
+
+    /**
+     * @brief Forgets all strings, blocks are kept for reuse
+     */
+    void reset();
+
+    /**
+     * @brief Frees blocks not used since last reset()
+     */
+    void trim();
+
+    /**
+     * @brief Bytes held in blocks, used or not
+     */
+    qint64 allocatedBytes() const { return m_allocatedBytes; }
+
+    /**
+     * @brief Bytes of strings stored since last reset()
+     */
+    qint64 usedBytes() const { return m_storedChars * qint64( sizeof( QChar ) ); }
+
+private:
+    RowArena( const RowArena& );
+    RowArena& operator=( const RowArena& );
+
+    void nextBlock( int minChars );
+
+    const int        m_blockChars;
+    QVector<QChar *> m_blocks;
+    QVector<int>     m_sizes;
+    int              m_current; // block being filled, -1 before first store
+    int              m_used;    // chars used in current block
+    qint64           m_storedChars;
+    qint64           m_allocatedBytes;
+};
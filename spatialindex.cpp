@@ -0,0 +1,244 @@
+#include "spatialindex.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+const int    maxGridSide  = 1024;
+const int    maxCellIndex = 1 << 20;
+const double minCellSize  = 0.01; // 10 m, closer points are the same stop anyway
+
+bool closerThan( const SpatialIndex::Hit& left, const SpatialIndex::Hit& right )
+{
+    return left.distanceKm < right.distanceKm;
+}
+
+int clampedCell( const double offset, const double cellSize )
+{
+    const double cell = std::floor( offset / cellSize );
+    if (cell < -maxCellIndex) {
+        return -maxCellIndex;
+    }
+    if (cell > maxCellIndex) {
+        return maxCellIndex;
+    }
+    return static_cast<int>( cell );
+}
+
+void toDistances( QVector<SpatialIndex::Hit>& hits )
+{
+    std::sort( hits.begin(), hits.end(), closerThan );
+    for (int i = 0; i < hits.size(); ++i) {
+        hits[i].distanceKm = std::sqrt( hits[i].distanceKm );
+    }
+}
+}
+
+SpatialIndex::SpatialIndex()
+  : m_refLatitude( 0.0 )
+  , m_minX( 0.0 )
+  , m_minY( 0.0 )
+  , m_cellSize( 1.0 )
+  , m_cols( 0 )
+  , m_rows( 0 )
+{
+}
+
+void SpatialIndex::clear()
+{
+    m_cols = 0;
+    m_rows = 0;
+    m_cellStart.clear();
+    m_ids.clear();
+    m_points.clear();
+}
+
+void SpatialIndex::rebuild(const QVector<Entry> &entries)
+{
+    clear();
+
+    double latitudeSum = 0.0;
+    int count = 0;
+    for (int i = 0; i < entries.size(); ++i) {
+        if (entries[i].point.valid) {
+            latitudeSum += entries[i].point.latitude;
+            ++count;
+        }
+    }
+    if (0 == count) {
+        return;
+    }
+    m_refLatitude = latitudeSum / count;
+
+    QVector<PlanarPoint> projected( entries.size() );
+    double maxX = 0.0;
+    double maxY = 0.0;
+    bool first = true;
+    for (int i = 0; i < entries.size(); ++i) {
+        if (!entries[i].point.valid) {
+            continue;
+        }
+        const PlanarPoint p = toPlane( entries[i].point, m_refLatitude );
+        projected[i] = p;
+        if (first) {
+            m_minX = maxX = p.x;
+            m_minY = maxY = p.y;
+            first = false;
+        }
+        else {
+            m_minX = std::min( m_minX, p.x );
+            m_minY = std::min( m_minY, p.y );
+            maxX = std::max( maxX, p.x );
+            maxY = std::max( maxY, p.y );
+        }
+    }
+
+    // about one point per cell keeps both queries close to O(k)
+    const double width  = maxX - m_minX;
+    const double height = maxY - m_minY;
+    m_cellSize = width * height > 0.0 ? std::sqrt( width * height / count )
+                                      : std::max( width, height ) / count;
+    m_cellSize = std::max( m_cellSize, std::max( width, height ) / (maxGridSide - 1) );
+    m_cellSize = std::max( m_cellSize, minCellSize );
+    m_cols = static_cast<int>( width / m_cellSize ) + 1;
+    m_rows = static_cast<int>( height / m_cellSize ) + 1;
+
+    // counting sort of points into cells
+    QVector<int> cellOf( entries.size(), -1 );
+    m_cellStart.fill( 0, m_cols * m_rows + 1 );
+    for (int i = 0; i < entries.size(); ++i) {
+        if (entries[i].point.valid) {
+            const int cell = cellY( projected[i].y ) * m_cols + cellX( projected[i].x );
+            cellOf[i] = cell;
+            ++m_cellStart[cell + 1];
+        }
+    }
+    for (int c = 0; c < m_cols * m_rows; ++c) {
+        m_cellStart[c + 1] += m_cellStart[c];
+    }
+
+    m_ids.resize( count );
+    m_points.resize( count );
+    QVector<int> fill( m_cellStart );
+    for (int i = 0; i < entries.size(); ++i) {
+        if (-1 != cellOf[i]) {
+            const int slot = fill[cellOf[i]]++;
+            m_ids[slot] = entries[i].id;
+            m_points[slot] = projected[i];
+        }
+    }
+}
+
+int SpatialIndex::cellX(const double x) const
+{
+    return clampedCell( x - m_minX, m_cellSize );
+}
+
+int SpatialIndex::cellY(const double y) const
+{
+    return clampedCell( y - m_minY, m_cellSize );
+}
+
+void SpatialIndex::scanCell(const int cx, const int cy, const PlanarPoint &from, const int k, QVector<Hit> &heap) const
+{
+    const int cell = cy * m_cols + cx;
+    for (int i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i) {
+        Hit hit;
+        hit.id = m_ids[i];
+        hit.distanceKm = squaredDistance( from, m_points[i] ); // squared until toDistances()
+
+        if (heap.size() < k) {
+            heap.append( hit );
+            std::push_heap( heap.begin(), heap.end(), closerThan );
+        }
+        else if (hit.distanceKm < heap.front().distanceKm) {
+            std::pop_heap( heap.begin(), heap.end(), closerThan );
+            heap.back() = hit;
+            std::push_heap( heap.begin(), heap.end(), closerThan );
+        }
+    }
+}
+
+QVector<SpatialIndex::Hit> SpatialIndex::nearest(const GeoPoint &from, int k) const
+{
+    QVector<Hit> heap;
+    if (!from.valid || k <= 0 || isEmpty()) {
+        return heap;
+    }
+    k = std::min( k, size() );
+    heap.reserve( k );
+
+    const PlanarPoint p = toPlane( from, m_refLatitude );
+    const int qx = cellX( p.x );
+    const int qy = cellY( p.y );
+
+    // Chebyshev ring distances (in cells) from the query cell to the grid
+    const int firstRing = std::max( std::max( -qx, qx - (m_cols - 1) ),
+                                    std::max( std::max( -qy, qy - (m_rows - 1) ), 0 ) );
+    const int lastRing  = std::max( std::max( qx, m_cols - 1 - qx ),
+                                    std::max( qy, m_rows - 1 - qy ) );
+
+    for (int r = firstRing; r <= lastRing; ++r) {
+        const int y0 = std::max( qy - r, 0 );
+        const int y1 = std::min( qy + r, m_rows - 1 );
+        for (int cy = y0; cy <= y1; ++cy) {
+            if (cy == qy - r || cy == qy + r) {
+                const int x0 = std::max( qx - r, 0 );
+                const int x1 = std::min( qx + r, m_cols - 1 );
+                for (int cx = x0; cx <= x1; ++cx) {
+                    scanCell( cx, cy, p, k, heap );
+                }
+            }
+            else {
+                if (qx - r >= 0 && qx - r < m_cols) {
+                    scanCell( qx - r, cy, p, k, heap );
+                }
+                if (r > 0 && qx + r >= 0 && qx + r < m_cols) {
+                    scanCell( qx + r, cy, p, k, heap );
+                }
+            }
+        }
+
+        // anything beyond ring r is at least r cells away
+        const double reach = r * m_cellSize;
+        if (heap.size() == k && heap.front().distanceKm <= reach * reach) {
+            break;
+        }
+    }
+
+    toDistances( heap );
+    return heap;
+}
+
+QVector<SpatialIndex::Hit> SpatialIndex::withinRadius(const GeoPoint &from, const double radiusKm) const
+{
+    QVector<Hit> hits;
+    if (!from.valid || radiusKm < 0.0 || isEmpty()) {
+        return hits;
+    }
+
+    const PlanarPoint p = toPlane( from, m_refLatitude );
+    const double limit = radiusKm * radiusKm;
+    const int x0 = std::max( cellX( p.x - radiusKm ), 0 );
+    const int x1 = std::min( cellX( p.x + radiusKm ), m_cols - 1 );
+    const int y0 = std::max( cellY( p.y - radiusKm ), 0 );
+    const int y1 = std::min( cellY( p.y + radiusKm ), m_rows - 1 );
+
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            const int cell = cy * m_cols + cx;
+            for (int i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i) {
+                const double d = squaredDistance( p, m_points[i] );
+                if (d <= limit) {
+                    Hit hit;
+                    hit.id = m_ids[i];
+                    hit.distanceKm = d;
+                    hits.append( hit );
+                }
+            }
+        }
+    }
+
+    toDistances( hits );
+    return hits;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "geopoint.h"
+#include <QVector>
+
+/**
+ * @brief Static uniform-grid index over geocoded points.
+ *
+ * Rebuilt as a whole on every refresh (O(n) counting sort into cells sized
+ * for about one point each), then answers k-nearest and radius queries by
+ * scanning only the cells around the query point.
+ */
+class SpatialIndex
+{
+public:
+    struct Entry
+    {
+        int      id;
+        GeoPoint point;
+    };
+
+    struct Hit
+    {
+        int    id;
+        double distanceKm;
+    };
+
+    SpatialIndex();
+
+    /**
+     * @brief Drops previous contents and indexes entries (invalid points are skipped)
+     */
+    void rebuild( const QVector<Entry>& entries );
+    void clear();
+
+    int size() const { return m_ids.size(); }
+    bool isEmpty() const { return m_ids.isEmpty(); }
+
+    /**
+     * @brief Up to k entries closest to from, nearest first
+     */
+    QVector<Hit> nearest( const GeoPoint& from, int k ) const;
+
+    /**
+     * @brief All entries not farther than radiusKm from from, nearest first
+     */
+    QVector<Hit> withinRadius( const GeoPoint& from, double radiusKm ) const;
+
+private:
+    int cellX( double x ) const;
+    int cellY( double y ) const;
+    void scanCell( int cx, int cy, const PlanarPoint& from, int k, QVector<Hit>& heap ) const;
+
+    double m_refLatitude;
+    double m_minX;
+    double m_minY;
+    double m_cellSize;
+    int    m_cols;
+    int    m_rows;
+
+    QVector<int>         m_cellStart; // m_cols * m_rows + 1 offsets into arrays below
+    QVector<int>         m_ids;
+    QVector<PlanarPoint> m_points;
+};